@@ -7,22 +7,103 @@
 #include <cstdint>
 #include <algorithm>
 #include <filesystem>
+#include <map>
+#include <queue>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <sstream>
+#if defined(__GNUC__) && defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
 
 using namespace std;
 namespace fs = std::filesystem;
 
 namespace Compression {
 
+// CRC32C (polinomio de Castagnoli) para verificar la integridad de los archivos comprimidos.
+// En x86-64 usa la instruccion crc32 de SSE4.2 si el procesador la tiene; si no, una tabla
+class CRC32C {
+    static const uint32_t POLY = 0x82F63B78; // Polinomio reflejado
+
+    static uint32_t software(const uint8_t *data, size_t size, uint32_t crc) {
+        static const vector<uint32_t> table = [] {
+            vector<uint32_t> t(256);
+            for (uint32_t i = 0; i < 256; i++) {
+                uint32_t c = i;
+                for (int k = 0; k < 8; k++) c = (c & 1) ? (c >> 1) ^ POLY : c >> 1;
+                t[i] = c;
+            }
+            return t;
+        }();
+        for (size_t i = 0; i < size; i++) {
+            crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+        }
+        return crc;
+    }
+
+#if defined(__GNUC__) && defined(__x86_64__)
+    __attribute__((target("sse4.2")))
+    static uint32_t hardware(const uint8_t *data, size_t size, uint32_t crc) {
+        uint64_t c = crc;
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8) {
+            uint64_t word;
+            memcpy(&word, data + i, 8);
+            c = _mm_crc32_u64(c, word);
+        }
+        for (; i < size; i++) {
+            c = _mm_crc32_u8((uint32_t)c, data[i]);
+        }
+        return (uint32_t)c;
+    }
+#endif
+
+public:
+    // previous permite encadenar: compute(b, compute(a)) es el CRC de a seguido de b
+    static uint32_t compute(const uint8_t *data, size_t size, uint32_t previous = 0) {
+#if defined(__GNUC__) && defined(__x86_64__)
+        static const bool hasSSE42 = __builtin_cpu_supports("sse4.2");
+        if (hasSSE42) return ~hardware(data, size, ~previous);
+#endif
+        return ~software(data, size, ~previous);
+    }
+
+    static uint32_t compute(const vector<uint8_t> &data, uint32_t previous = 0) {
+        return compute(data.data(), data.size(), previous);
+    }
+};
+
 // Funciona para texto o archivos binarios (imagenes, videos, etc.)
 class LZW {
-    static const int MAX_BITS = 16;
-    static const int MAX_TABLE_SIZE = 1 << MAX_BITS;
+    int maxBits;      // Ancho de cada codigo al guardarse
+    int maxTableSize; // Cantidad maxima de entradas del diccionario
 
 public:
+    // El formato .rar usa codigos de 12 bits; el modo LZW + Huffman usa 16
+    LZW(int bits = 12) : maxBits(bits), maxTableSize(1 << bits) {}
+
+    // Estado de la descompresion, permite decodificar los codigos por partes
+    struct DecodeState {
+        vector<string> dictionary;
+        string prev;
+        uint32_t nextCode = 256;
+    };
+
     // Recibe bytes (no solo texto)
     vector<uint16_t> compress(const vector<uint8_t> &input) {
-        unordered_map<string, uint16_t> dictionary;
         vector<uint16_t> output;
+        compressTo(input, [&](uint16_t code, size_t) { output.push_back(code); });
+        return output;
+    }
+
+    // Igual que compress, pero entrega cada codigo a emit apenas se genera,
+    // junto con la cantidad de bytes de entrada que representa
+    template <typename Emit>
+    void compressTo(const vector<uint8_t> &input, Emit emit) {
+        unordered_map<string, uint16_t> dictionary;
 
         // Inicializamos el diccionario con los 256 posibles bytes
         for (int i = 0; i < 256; i++) {
@@ -31,15 +112,15 @@ public:
         }
 
         string current;
-        uint16_t nextCode = 256;
+        uint32_t nextCode = 256;
 
         for (uint8_t byte : input) {
             string currentPlusC = current + (char)byte;
             if (dictionary.find(currentPlusC) != dictionary.end()) {
                 current = currentPlusC;
             } else {
-                output.push_back(dictionary[current]);
-                if (nextCode < MAX_TABLE_SIZE) {
+                emit(dictionary[current], current.size());
+                if (nextCode < (uint32_t)maxTableSize) {
                     dictionary[currentPlusC] = nextCode++;
                 }
                 current = string(1, (char)byte);
@@ -47,93 +128,599 @@ public:
         }
 
         if (!current.empty()) {
-            output.push_back(dictionary[current]);
+            emit(dictionary[current], current.size());
         }
-
-        return output;
     }
 
     // Descompresion
     vector<uint8_t> decompress(const vector<uint16_t> &codes) {
-        vector<string> dictionary(4096);
-        for (int i = 0; i < 256; i++) {
-            dictionary[i] = string(1, (char)i);
+        DecodeState state;
+        vector<uint8_t> bytes;
+        for (uint16_t code : codes) {
+            if (!decodeCode(state, code, bytes)) return {};
         }
+        return bytes;
+    }
 
-        uint16_t nextCode = 256;
-        string prev = dictionary[codes[0]];
-        string result = prev;
-
-        for (size_t i = 1; i < codes.size(); i++) {
-            uint16_t code = codes[i];
-            string entry;
+    // Decodifica un solo codigo y agrega sus bytes a out
+    bool decodeCode(DecodeState &state, uint16_t code, vector<uint8_t> &out) {
+        if (state.dictionary.empty()) {
+            state.dictionary.resize(maxTableSize);
+            for (int i = 0; i < 256; i++) {
+                state.dictionary[i] = string(1, (char)i);
+            }
+        }
 
-            if (code < nextCode) {
-                entry = dictionary[code];
-            } else if (code == nextCode) {
-                entry = prev + prev[0];
-            } else {
+        // El primer codigo siempre es un byte suelto
+        if (state.prev.empty()) {
+            if (code >= 256) {
                 cerr << "Error en descompresion: codigo invalido";
-                return {};
+                return false;
             }
+            state.prev = state.dictionary[code];
+            out.insert(out.end(), state.prev.begin(), state.prev.end());
+            return true;
+        }
 
-            result += entry;
-            if (nextCode < MAX_TABLE_SIZE) {
-                dictionary[nextCode++] = prev + entry[0];
-            }
-            prev = entry;
+        string entry;
+        if (code < state.nextCode) {
+            entry = state.dictionary[code];
+        } else if (code == state.nextCode) {
+            entry = state.prev + state.prev[0];
+        } else {
+            cerr << "Error en descompresion: codigo invalido";
+            return false;
         }
 
-        // Convertimos string resultante a bytes
-        vector<uint8_t> bytes(result.begin(), result.end());
-        return bytes;
+        out.insert(out.end(), entry.begin(), entry.end());
+        if (state.nextCode < (uint32_t)maxTableSize) {
+            state.dictionary[state.nextCode++] = state.prev + entry[0];
+        }
+        state.prev = entry;
+        return true;
     }
 
-    // Guardamos el comprimido
+    // Tamaño del trailer del .rar: cantidad de codigos (4 bytes) | CRC32C de los codigos empaquetados (4 bytes)
+    static const size_t TRAILER_SIZE = 8;
+
+    // Guardamos el comprimido (codigos empaquetados seguidos del trailer)
     void saveCompressed(const string &filename, const vector<uint16_t> &codes) {
         ofstream out(filename, ios::binary);
+        vector<uint8_t> packed;
         uint32_t buffer = 0;
         int bitsInBuffer = 0;
 
         for (uint16_t code : codes) {
-            buffer |= (code << bitsInBuffer);
-            bitsInBuffer += 12;
+            buffer |= ((uint32_t)code << bitsInBuffer);
+            bitsInBuffer += maxBits;
             while (bitsInBuffer >= 8) {
-                out.put(buffer & 0xFF);
+                packed.push_back(buffer & 0xFF);
                 buffer >>= 8;
                 bitsInBuffer -= 8;
             }
         }
 
         if (bitsInBuffer > 0) {
-            out.put(buffer & 0xFF);
+            packed.push_back(buffer & 0xFF);
         }
 
+        uint32_t count = codes.size();
+        uint32_t crc = CRC32C::compute(packed);
+        out.write(reinterpret_cast<const char *>(packed.data()), packed.size());
+        for (int i = 0; i < 4; i++) out.put((count >> (8 * i)) & 0xFF);
+        for (int i = 0; i < 4; i++) out.put((crc >> (8 * i)) & 0xFF);
+
         out.close();
     }
 
-    // Cargamos el comprimido
+    // Cargamos el comprimido. Devuelve vacio si el trailer falta o el CRC no coincide
     vector<uint16_t> loadCompressed(const string &filename) {
         ifstream in(filename, ios::binary);
         vector<uint16_t> codes;
         vector<uint8_t> bytes((istreambuf_iterator<char>(in)), {});
+        if (bytes.size() < TRAILER_SIZE) {
+            cerr << "Error: " << filename << " no tiene trailer de verificacion\n";
+            return {};
+        }
+
+        // Separa el trailer de los codigos empaquetados
+        const uint8_t *trailer = bytes.data() + bytes.size() - TRAILER_SIZE;
+        uint32_t count = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | ((uint32_t)trailer[3] << 24);
+        uint32_t crc = trailer[4] | (trailer[5] << 8) | (trailer[6] << 16) | ((uint32_t)trailer[7] << 24);
+        bytes.resize(bytes.size() - TRAILER_SIZE);
+        if (CRC32C::compute(bytes) != crc) {
+            cerr << "Error: CRC invalido en " << filename << "\n";
+            return {};
+        }
+
         uint32_t buffer = 0;
         int bitsInBuffer = 0;
 
         for (uint8_t byte : bytes) {
             buffer |= (byte << bitsInBuffer);
             bitsInBuffer += 8;
-            while (bitsInBuffer >= 12) {
-                uint16_t code = buffer & 0xFFF;
+            while (bitsInBuffer >= maxBits) {
+                uint16_t code = buffer & (maxTableSize - 1);
                 codes.push_back(code);
-                buffer >>= 12;
-                bitsInBuffer -= 12;
+                buffer >>= maxBits;
+                bitsInBuffer -= maxBits;
             }
         }
+
+        if (codes.size() < count) {
+            cerr << "Error: " << filename << " tiene menos codigos que los indicados en el trailer\n";
+            return {};
+        }
+        codes.resize(count);
         return codes;
     }
 };
 
+// Huffman para simbolos de 16 bits (los codigos LZW).
+// Guarda solo la longitud de cada codigo y reconstruye los prefijos en forma canonica
+class Huffman16 {
+    // Nodo del arbol: hoja (un simbolo) o nodo interno
+    struct Node {
+        uint16_t symbol;
+        uint32_t freq;
+        Node *left, *right;
+
+        Node(uint16_t s, uint32_t f) : symbol(s), freq(f), left(nullptr), right(nullptr) {}
+    };
+
+    // Menor frecuencia = mayor prioridad
+    struct Compare {
+        bool operator()(Node *a, Node *b) { return a->freq > b->freq; }
+    };
+
+    static void collectLengths(Node *node, uint8_t depth, map<uint16_t, uint8_t> &lengths) {
+        if (!node) return;
+        if (!node->left && !node->right) {
+            lengths[node->symbol] = depth == 0 ? 1 : depth; // Un unico simbolo usa 1 bit
+            return;
+        }
+        collectLengths(node->left, depth + 1, lengths);
+        collectLengths(node->right, depth + 1, lengths);
+    }
+
+    static void freeTree(Node *node) {
+        if (!node) return;
+        freeTree(node->left);
+        freeTree(node->right);
+        delete node;
+    }
+
+    // Simbolos ordenados por (longitud, simbolo), que es el orden canonico
+    static vector<pair<uint8_t, uint16_t>> canonicalOrder(const map<uint16_t, uint8_t> &lengths) {
+        vector<pair<uint8_t, uint16_t>> order;
+        for (auto &par : lengths) order.emplace_back(par.second, par.first);
+        sort(order.begin(), order.end());
+        return order;
+    }
+
+public:
+    // Longitud maxima de un codigo; con bloques de hasta 65536 simbolos nunca se supera
+    static const int MAX_CODE_LEN = 32;
+
+    // Construye el arbol con las frecuencias del bloque y devuelve la longitud de cada simbolo
+    static map<uint16_t, uint8_t> buildLengths(const vector<uint16_t> &symbols) {
+        map<uint16_t, uint32_t> freq;
+        for (uint16_t s : symbols) freq[s]++;
+
+        priority_queue<Node *, vector<Node *>, Compare> pq;
+        for (auto &par : freq) pq.push(new Node(par.first, par.second));
+
+        map<uint16_t, uint8_t> lengths;
+        if (pq.empty()) return lengths;
+
+        while (pq.size() > 1) {
+            Node *left = pq.top(); pq.pop();
+            Node *right = pq.top(); pq.pop();
+            Node *parent = new Node(0, left->freq + right->freq);
+            parent->left = left;
+            parent->right = right;
+            pq.push(parent);
+        }
+
+        collectLengths(pq.top(), 0, lengths);
+        freeTree(pq.top());
+        return lengths;
+    }
+
+    // Codifica los simbolos (bits del mas significativo al menos significativo)
+    static vector<uint8_t> encode(const vector<uint16_t> &symbols, const map<uint16_t, uint8_t> &lengths) {
+        // Asigna los prefijos canonicos: mismo largo -> codigos consecutivos
+        unordered_map<uint16_t, pair<uint32_t, uint8_t>> codes;
+        uint32_t code = 0;
+        uint8_t prevLen = 0;
+        for (auto &par : canonicalOrder(lengths)) {
+            code <<= (par.first - prevLen);
+            codes[par.second] = {code, par.first};
+            prevLen = par.first;
+            code++;
+        }
+
+        vector<uint8_t> out;
+        uint64_t buffer = 0;
+        int bitsInBuffer = 0;
+        for (uint16_t s : symbols) {
+            auto &c = codes[s];
+            buffer = (buffer << c.second) | c.first;
+            bitsInBuffer += c.second;
+            while (bitsInBuffer >= 8) {
+                out.push_back((buffer >> (bitsInBuffer - 8)) & 0xFF);
+                bitsInBuffer -= 8;
+            }
+        }
+        if (bitsInBuffer > 0) {
+            out.push_back((buffer << (8 - bitsInBuffer)) & 0xFF);
+        }
+        return out;
+    }
+
+    // Decodifica count simbolos. Devuelve false si los datos no son validos
+    static bool decode(const vector<uint8_t> &data, const map<uint16_t, uint8_t> &lengths,
+                       uint32_t count, vector<uint16_t> &symbols) {
+        auto order = canonicalOrder(lengths);
+
+        // Para cada longitud: primer codigo, cantidad y posicion del primer simbolo en order
+        vector<uint32_t> firstCode(MAX_CODE_LEN + 1, 0), lenCount(MAX_CODE_LEN + 1, 0), firstIndex(MAX_CODE_LEN + 1, 0);
+        for (auto &par : order) {
+            if (par.first == 0 || par.first > MAX_CODE_LEN) return false;
+            lenCount[par.first]++;
+        }
+        uint32_t code = 0, index = 0;
+        for (int len = 1; len <= MAX_CODE_LEN; len++) {
+            code = (code + lenCount[len - 1]) << 1;
+            firstCode[len] = code;
+            firstIndex[len] = index;
+            index += lenCount[len];
+        }
+
+        symbols.clear();
+        symbols.reserve(count);
+        code = 0;
+        int len = 0;
+        for (uint8_t byte : data) {
+            for (int bit = 7; bit >= 0 && symbols.size() < count; bit--) {
+                code = (code << 1) | ((byte >> bit) & 1);
+                len++;
+                if (code - firstCode[len] < lenCount[len]) {
+                    symbols.push_back(order[firstIndex[len] + code - firstCode[len]].second);
+                    code = 0;
+                    len = 0;
+                } else if (len == MAX_CODE_LEN) {
+                    return false;
+                }
+            }
+        }
+        return symbols.size() == count;
+    }
+};
+
+// Cola con capacidad limitada que conecta dos etapas del pipeline.
+// push bloquea si esta llena y pop si esta vacia; close indica que no habra mas datos
+template <typename T>
+class BoundedQueue {
+    queue<T> items;
+    size_t capacity;
+    bool closed = false;
+    mutex m;
+    condition_variable notFull, notEmpty;
+
+public:
+    explicit BoundedQueue(size_t cap) : capacity(cap) {}
+
+    void push(T item) {
+        unique_lock<mutex> lock(m);
+        notFull.wait(lock, [&] { return items.size() < capacity || closed; });
+        if (closed) return;
+        items.push(move(item));
+        notEmpty.notify_one();
+    }
+
+    // Devuelve false cuando la cola esta cerrada y ya no quedan elementos
+    bool pop(T &item) {
+        unique_lock<mutex> lock(m);
+        notEmpty.wait(lock, [&] { return !items.empty() || closed; });
+        if (items.empty()) return false;
+        item = move(items.front());
+        items.pop();
+        notFull.notify_one();
+        return true;
+    }
+
+    void close() {
+        lock_guard<mutex> lock(m);
+        closed = true;
+        notFull.notify_all();
+        notEmpty.notify_all();
+    }
+};
+
+// Pipeline LZW + Huffman: los codigos LZW (16 bits) se agrupan en bloques y cada bloque
+// se codifica con Huffman. LZW y Huffman corren en hilos distintos unidos por una BoundedQueue.
+// Casi todos los codigos aparecen una sola vez, asi que Huffman se aplica al byte alto
+// (que es donde esta la redundancia) y el byte bajo se guarda tal cual.
+// Cada bloque lleva el CRC32C de los bytes originales que representa; al descomprimir
+// un tercer hilo lo verifica mientras LZW sigue decodificando los bloques siguientes.
+//
+// Formato del archivo .lzh:
+//   "LZWH" | bits (1 byte)
+//   por bloque: cantidad de codigos (4 bytes) | bytes originales (4 bytes) | CRC32C (4 bytes)
+//               | cantidad de simbolos (4 bytes, a lo sumo 256)
+//               | (simbolo 2 bytes, longitud 1 byte) por simbolo | bytes del payload (4 bytes)
+//               | CRC32C del encabezado del bloque (4 bytes)
+//               | payload (bytes altos con Huffman) | bytes bajos (1 por codigo)
+//   fin: 0 codigos (4 bytes) | tamaño original total (8 bytes) | CRC32C del archivo completo (4 bytes)
+//   un archivo sin este cierre se considera truncado
+class LZWHuffmanPipeline {
+    static const int BITS = 16;
+    static const size_t BLOCK_CODES = 1 << 15; // Codigos por bloque
+    static const size_t QUEUE_BLOCKS = 4;      // Bloques en vuelo entre etapas
+
+    // Bloque de codigos LZW y los bytes originales que representa
+    struct Block {
+        vector<uint16_t> codes;
+        size_t start = 0;   // Offset del primer byte en el original (solo al comprimir)
+        uint32_t bytes = 0; // Cantidad de bytes originales
+        uint32_t crc = 0;   // CRC32C de esos bytes
+    };
+
+    // Bytes ya decodificados de un bloque, listos para verificar
+    struct DecodedBlock {
+        vector<uint8_t> data;
+        uint32_t crc = 0;
+    };
+
+    static void writeU16(ostream &out, uint16_t v) {
+        out.put(v & 0xFF);
+        out.put(v >> 8);
+    }
+
+    static void writeU32(ostream &out, uint32_t v) {
+        for (int i = 0; i < 4; i++) out.put((v >> (8 * i)) & 0xFF);
+    }
+
+    static void writeU64(ostream &out, uint64_t v) {
+        for (int i = 0; i < 8; i++) out.put((v >> (8 * i)) & 0xFF);
+    }
+
+    static bool readU16(istream &in, uint16_t &v) {
+        uint8_t b[2];
+        if (!in.read(reinterpret_cast<char *>(b), 2)) return false;
+        v = b[0] | (b[1] << 8);
+        return true;
+    }
+
+    static bool readU32(istream &in, uint32_t &v) {
+        uint8_t b[4];
+        if (!in.read(reinterpret_cast<char *>(b), 4)) return false;
+        v = b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+        return true;
+    }
+
+    static bool readU64(istream &in, uint64_t &v) {
+        uint32_t low, high;
+        if (!readU32(in, low) || !readU32(in, high)) return false;
+        v = ((uint64_t)high << 32) | low;
+        return true;
+    }
+
+    // Serializa el encabezado de un bloque; al archivo se escribe seguido de su CRC32C
+    static string encodeHeader(uint32_t codeCount, const Block &block,
+                               const map<uint16_t, uint8_t> &lengths, uint32_t payloadSize) {
+        ostringstream out;
+        writeU32(out, codeCount);
+        writeU32(out, block.bytes);
+        writeU32(out, block.crc);
+        writeU32(out, lengths.size());
+        for (auto &par : lengths) {
+            writeU16(out, par.first);
+            out.put(par.second);
+        }
+        writeU32(out, payloadSize);
+        return out.str();
+    }
+
+    static uint32_t headerCrc(const string &header) {
+        return CRC32C::compute(reinterpret_cast<const uint8_t *>(header.data()), header.size());
+    }
+
+public:
+    // Comprime input y lo guarda en filename. Devuelve el tamaño escrito en bytes (0 si fallo la escritura)
+    size_t compressFile(const vector<uint8_t> &input, const string &filename) {
+        ofstream out(filename, ios::binary);
+        if (!out) {
+            cerr << "Error: no se pudo crear " << filename << "\n";
+            return 0;
+        }
+        out.write("LZWH", 4);
+        out.put(BITS);
+
+        // Etapa 1 (hilo aparte): LZW genera codigos y los entrega por bloques
+        BoundedQueue<Block> blocks(QUEUE_BLOCKS);
+        thread producer([&] {
+            LZW lzw(BITS);
+            Block block;
+            block.codes.reserve(BLOCK_CODES);
+            lzw.compressTo(input, [&](uint16_t code, size_t length) {
+                block.codes.push_back(code);
+                block.bytes += length;
+                if (block.codes.size() == BLOCK_CODES) {
+                    size_t next = block.start + block.bytes;
+                    blocks.push(move(block));
+                    block = Block();
+                    block.start = next;
+                    block.codes.reserve(BLOCK_CODES);
+                }
+            });
+            if (!block.codes.empty()) blocks.push(move(block));
+            blocks.close();
+        });
+
+        // Etapa 2 (este hilo): CRC de los bytes originales, Huffman de los codigos y escritura
+        Block block;
+        while (blocks.pop(block)) {
+            const vector<uint16_t> &codes = block.codes;
+            vector<uint16_t> high(codes.size());
+            vector<uint8_t> low(codes.size());
+            for (size_t i = 0; i < codes.size(); i++) {
+                high[i] = codes[i] >> 8;
+                low[i] = codes[i] & 0xFF;
+            }
+            auto lengths = Huffman16::buildLengths(high);
+            auto payload = Huffman16::encode(high, lengths);
+
+            block.crc = CRC32C::compute(input.data() + block.start, block.bytes);
+            string header = encodeHeader(codes.size(), block, lengths, payload.size());
+            out.write(header.data(), header.size());
+            writeU32(out, headerCrc(header));
+            out.write(reinterpret_cast<const char *>(payload.data()), payload.size());
+            out.write(reinterpret_cast<const char *>(low.data()), low.size());
+        }
+        producer.join();
+
+        writeU32(out, 0);
+        writeU64(out, input.size());
+        writeU32(out, CRC32C::compute(input));
+        if (!out) {
+            cerr << "Error al escribir " << filename << "\n";
+            return 0;
+        }
+        size_t written = out.tellp();
+        out.close();
+        return written;
+    }
+
+    // Lee un archivo .lzh y devuelve los bytes originales (vacio si hubo error o si algun CRC no coincide)
+    vector<uint8_t> decompressFile(const string &filename) {
+        ifstream in(filename, ios::binary);
+        char magic[4];
+        if (!in.read(magic, 4) || string(magic, 4) != "LZWH" || in.get() != BITS) {
+            cerr << "Error: " << filename << " no es un archivo LZW + Huffman valido\n";
+            return {};
+        }
+
+        // Etapa 1 (hilo aparte): lee cada bloque y decodifica Huffman -> codigos LZW
+        BoundedQueue<Block> blocks(QUEUE_BLOCKS);
+        bool formatError = false;
+        uint64_t totalBytes = 0;
+        uint32_t totalCrc = 0;
+        thread producer([&] {
+            uint32_t codeCount;
+            while (true) {
+                // Solo el cierre explicito termina el archivo; un EOF aca es un archivo truncado
+                if (!readU32(in, codeCount)) {
+                    formatError = true;
+                    break;
+                }
+                if (codeCount == 0) {
+                    if (!readU64(in, totalBytes) || !readU32(in, totalCrc)) formatError = true;
+                    break;
+                }
+                // Cada campo del encabezado se valida antes de usarlo para reservar memoria.
+                // Un codigo representa como mucho 2^BITS bytes y solo se codifican bytes altos (256 simbolos)
+                Block block;
+                uint32_t symbolCount, payloadSize, storedCrc;
+                map<uint16_t, uint8_t> lengths;
+                bool ok = codeCount <= BLOCK_CODES
+                          && readU32(in, block.bytes) && block.bytes >= codeCount
+                          && (uint64_t)block.bytes <= ((uint64_t)codeCount << BITS)
+                          && readU32(in, block.crc)
+                          && readU32(in, symbolCount) && symbolCount >= 1 && symbolCount <= 256;
+                for (uint32_t i = 0; ok && i < symbolCount; i++) {
+                    uint16_t symbol;
+                    ok = readU16(in, symbol) && symbol < 256;
+                    int length = ok ? in.get() : EOF;
+                    ok = ok && length != EOF && lengths.emplace(symbol, length).second;
+                }
+                ok = ok && readU32(in, payloadSize)
+                        && (uint64_t)payloadSize <= (uint64_t)codeCount * Huffman16::MAX_CODE_LEN / 8 + 1
+                        && readU32(in, storedCrc)
+                        && headerCrc(encodeHeader(codeCount, block, lengths, payloadSize)) == storedCrc;
+
+                vector<uint8_t> payload(ok ? payloadSize : 0), low(ok ? codeCount : 0);
+                vector<uint16_t> &codes = block.codes;
+                ok = ok && in.read(reinterpret_cast<char *>(payload.data()), payloadSize)
+                        && in.read(reinterpret_cast<char *>(low.data()), codeCount)
+                        && Huffman16::decode(payload, lengths, codeCount, codes);
+                if (!ok) {
+                    formatError = true;
+                    break;
+                }
+                for (uint32_t i = 0; i < codeCount; i++) {
+                    codes[i] = (codes[i] << 8) | low[i];
+                }
+                blocks.push(move(block));
+            }
+            blocks.close();
+        });
+
+        // Etapa 3 (hilo aparte): verifica el CRC de cada bloque decodificado y arma el resultado
+        BoundedQueue<DecodedBlock> decoded(QUEUE_BLOCKS);
+        vector<uint8_t> result;
+        size_t corruptBlock = 0;
+        bool checksumError = false;
+        uint32_t resultCrc = 0;
+        thread verifier([&] {
+            DecodedBlock d;
+            for (size_t index = 0; decoded.pop(d); index++) {
+                if (!checksumError && CRC32C::compute(d.data) != d.crc) {
+                    checksumError = true;
+                    corruptBlock = index;
+                }
+                resultCrc = CRC32C::compute(d.data, resultCrc);
+                result.insert(result.end(), d.data.begin(), d.data.end());
+            }
+        });
+
+        // Etapa 2 (este hilo): LZW reconstruye los bytes a medida que llegan los bloques
+        LZW lzw(BITS);
+        LZW::DecodeState state;
+        Block block;
+        bool decodeError = false;
+        while (blocks.pop(block)) {
+            DecodedBlock d;
+            d.crc = block.crc;
+            for (uint16_t code : block.codes) {
+                if (!lzw.decodeCode(state, code, d.data)) {
+                    decodeError = true;
+                    break;
+                }
+                if (d.data.size() > block.bytes) break; // No sigue creciendo mas alla de lo declarado
+            }
+            if (!decodeError && d.data.size() != block.bytes) {
+                cerr << "Error en descompresion: el bloque no tiene el tamaño esperado";
+                decodeError = true;
+            }
+            if (decodeError) {
+                blocks.close(); // Libera al productor si estaba esperando lugar en la cola
+                break;
+            }
+            decoded.push(move(d));
+        }
+        decoded.close();
+        producer.join();
+        verifier.join();
+
+        if (formatError) {
+            cerr << "Error: bloque corrupto o archivo truncado en " << filename << "\n";
+            return {};
+        }
+        if (decodeError) return {};
+        if (checksumError) {
+            cerr << "Error: CRC invalido en el bloque " << corruptBlock << " de " << filename << "\n";
+            return {};
+        }
+        if (result.size() != totalBytes || resultCrc != totalCrc) {
+            cerr << "Error: el tamaño o el CRC total no coinciden en " << filename << "\n";
+            return {};
+        }
+        return result;
+    }
+};
+
 // Lee el archivo binario completo 
 vector<uint8_t> readBinaryFile(const string &path) {
     ifstream file(path, ios::binary);
@@ -167,8 +754,14 @@ int main() {
     cout << "Ingrese el nombre del archivo a comprimir (ej: imagen.jpg): ";
     getline(cin, fileName);
 
+    // Modo 1: LZW con codigos de 12 bits. Modo 2: pipeline LZW (16 bits) + Huffman
+    string modo;
+    cout << "Modo de compresion (1 = LZW .rar, 2 = LZW + Huffman .lzh): ";
+    getline(cin, modo);
+    bool pipeline = (modo == "2");
+
     string inputFile = defaultPath + fileName;
-    string compressedFile = compressedFolder + fileName + ".rar";
+    string compressedFile = compressedFolder + fileName + (pipeline ? ".lzh" : ".rar");
     string decompressedFile = restoredFolder + fileName;
 
     // Lee el archivo
@@ -179,11 +772,24 @@ int main() {
 
     // Comprime
     Compression::LZW lzw;
-    auto comprimido = lzw.compress(originalData);
-    lzw.saveCompressed(compressedFile, comprimido);
+    Compression::LZWHuffmanPipeline lzh;
+    if (pipeline) {
+        size_t escritos = lzh.compressFile(originalData, compressedFile);
+        if (escritos == 0) return 1;
+        cout << "Archivo comprimido guardado en: " << compressedFile
+             << " (" << escritos << " bytes)\n";
+    } else {
+        auto comprimido = lzw.compress(originalData);
+        lzw.saveCompressed(compressedFile, comprimido);
+        cout << "Archivo comprimido guardado en: " << compressedFile
+             << " (~" << (comprimido.size() * 12) / 8 + Compression::LZW::TRAILER_SIZE << " bytes)\n";
+    }
 
-    cout << "Archivo comprimido guardado en: " << compressedFile
-         << " (~" << (comprimido.size() * 12) / 8 << " bytes)\n";
+    // Para verificar basta con el CRC y el tamaño: el original ya no hace falta en memoria
+    // (el .lzh ademas guarda un CRC por bloque que decompressFile verifica solo)
+    size_t tamOriginal = originalData.size();
+    uint32_t crcOriginal = Compression::CRC32C::compute(originalData);
+    vector<uint8_t>().swap(originalData);
 
     // Preguntar si desea descomprimir
     char respuesta;
@@ -191,17 +797,23 @@ int main() {
     cin >> respuesta;
 
     if (respuesta == 's' || respuesta == 'S') {
-        auto cargado = lzw.loadCompressed(compressedFile);
-        auto descomprimido = lzw.decompress(cargado);
+        vector<uint8_t> descomprimido;
+        if (pipeline) {
+            descomprimido = lzh.decompressFile(compressedFile);
+        } else {
+            auto cargado = lzw.loadCompressed(compressedFile);
+            descomprimido = lzw.decompress(cargado);
+        }
+        // Si la verificacion falla no se guarda nada, para no pisar una restauracion anterior
+        if (descomprimido.size() != tamOriginal || Compression::CRC32C::compute(descomprimido) != crcOriginal) {
+            cout << "Error: el archivo restaurado no coincide; no se guardo " << decompressedFile << "\n";
+            return 1;
+        }
         Compression::saveBinaryFile(decompressedFile, descomprimido);
 
         cout << "Archivo restaurado guardado en: " << decompressedFile << "\n";
         cout << "Tamaño descomprimido: " << descomprimido.size() << " bytes\n";
-
-        if (descomprimido == originalData)
-            cout << "Archivo restaurado correctamente\n";
-        else
-            cout << "Error: el archivo restaurado no coincide\n";
+        cout << "Archivo restaurado correctamente\n";
     } else {
         cout << "Se omitio la descompresion.\n";
     }
@@ -3,6 +3,9 @@
 #include <fstream>     
 #include <vector>        
 #include <filesystem>    
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
 using namespace std;
 namespace fs = std::filesystem; 
 
@@ -12,6 +15,9 @@ const string ASSETS_PATH = "assets/fbruta.txt";
 // Alfabeto valido para la fuerza bruta
 const string ALFABETO = "abcdefghijklmnopqrstuvwxyz";
 
+// Ruta del indice de sufijos del archivo de assets
+const string INDICE_PATH = ASSETS_PATH + ".idx";
+
 // Maxima longitud segura (+Caracteres = Kaboom)
 const size_t MAX_BRUTE_LEN = 6; // Longitud maxima segura para fuerza bruta
 
@@ -98,6 +104,19 @@ bool objetivoValidoParaBrute(const string& objetivo, const string& alfabeto) {
     return true;
 }
 
+// Muestra la cantidad de ocurrencias y sus offsets
+void mostrarPosiciones(const string& rutaArchivo, const vector<size_t>& posiciones) {
+    // Mostramos resultados segun si se encontraron o no ocurrencias
+    if (posiciones.empty()) {
+        cout << "Cadena no encontrada en el archivo." << endl;
+    } else {
+        cout << "Cadena encontrada " << posiciones.size() << " veces en " << rutaArchivo << "." << endl;
+        cout << "Posiciones (offset desde inicio del archivo, base 0): ";
+        for (size_t p : posiciones) cout << p << " ";
+        cout << endl;
+    }
+}
+
 // Busca una cadena (en texto) dentro de un archivo completo y muestra offsets
 void buscarCadenaEnArchivo(const string& rutaArchivo, const string& cadenaBuscada) {
     // Verifica la existencia del archivo
@@ -126,15 +145,320 @@ void buscarCadenaEnArchivo(const string& rutaArchivo, const string& cadenaBuscad
         pos = contenido.find(cadenaBuscada, pos + 1);
     }
 
-    // Mostramos resultados segun si se encontraron o no ocurrencias
-    if (posiciones.empty()) {
-        cout << "Cadena no encontrada en el archivo." << endl;
+    mostrarPosiciones(rutaArchivo, posiciones);
+}
+
+// Construye el arreglo de sufijos de s con SA-IS (tiempo lineal).
+// s tiene valores en [0, K); devuelve las posiciones de inicio de los sufijos en orden lexicografico
+vector<int> construirSAIS(const vector<int>& s, int K) {
+    int n = s.size();
+    if (n == 0) return {};
+    if (n == 1) return {0};
+    if (n == 2) return s[0] < s[1] ? vector<int>{0, 1} : vector<int>{1, 0};
+
+    vector<int> sa(n);
+    vector<bool> tipoS(n, false); // true = sufijo de tipo S (menor que el siguiente)
+    for (int i = n - 2; i >= 0; i--) {
+        tipoS[i] = (s[i] == s[i + 1]) ? tipoS[i + 1] : (s[i] < s[i + 1]);
+    }
+
+    // Inicio de cada cubeta para sufijos L y para sufijos S (una cubeta por simbolo)
+    vector<int> cubetaL(K + 1, 0), cubetaS(K + 1, 0);
+    for (int i = 0; i < n; i++) {
+        if (!tipoS[i]) cubetaS[s[i]]++;
+        else cubetaL[s[i] + 1]++;
+    }
+    for (int c = 0; c <= K; c++) {
+        cubetaS[c] += cubetaL[c];
+        if (c < K) cubetaL[c + 1] += cubetaS[c];
+    }
+
+    // Induce el orden de todos los sufijos a partir de las posiciones LMS ya ordenadas
+    auto inducir = [&](const vector<int>& lms) {
+        fill(sa.begin(), sa.end(), -1);
+        vector<int> cubeta(K + 1);
+        copy(cubetaS.begin(), cubetaS.end(), cubeta.begin());
+        for (int d : lms) {
+            if (d == n) continue;
+            sa[cubeta[s[d]]++] = d;
+        }
+        copy(cubetaL.begin(), cubetaL.end(), cubeta.begin());
+        sa[cubeta[s[n - 1]]++] = n - 1;
+        for (int i = 0; i < n; i++) {
+            int v = sa[i];
+            if (v >= 1 && !tipoS[v - 1]) sa[cubeta[s[v - 1]]++] = v - 1;
+        }
+        copy(cubetaL.begin(), cubetaL.end(), cubeta.begin());
+        for (int i = n - 1; i >= 0; i--) {
+            int v = sa[i];
+            if (v >= 1 && tipoS[v - 1]) sa[--cubeta[s[v - 1] + 1]] = v - 1;
+        }
+    };
+
+    // Posiciones LMS: tipo S con el anterior de tipo L
+    vector<int> indiceLMS(n + 1, -1);
+    vector<int> lms;
+    for (int i = 1; i < n; i++) {
+        if (!tipoS[i - 1] && tipoS[i]) {
+            indiceLMS[i] = lms.size();
+            lms.push_back(i);
+        }
+    }
+
+    inducir(lms);
+
+    if (!lms.empty()) {
+        // Ordena las subcadenas LMS y les asigna nombres; si hay repetidos se resuelve recursivamente
+        vector<int> lmsOrdenadas;
+        for (int v : sa) {
+            if (indiceLMS[v] != -1) lmsOrdenadas.push_back(v);
+        }
+        int m = lms.size();
+        vector<int> reducida(m);
+        int nombre = 0;
+        reducida[indiceLMS[lmsOrdenadas[0]]] = 0;
+        for (int i = 1; i < m; i++) {
+            int l = lmsOrdenadas[i - 1], r = lmsOrdenadas[i];
+            int finL = (indiceLMS[l] + 1 < m) ? lms[indiceLMS[l] + 1] : n;
+            int finR = (indiceLMS[r] + 1 < m) ? lms[indiceLMS[r] + 1] : n;
+            bool iguales = true;
+            if (finL - l != finR - r) {
+                iguales = false;
+            } else {
+                while (l < finL && s[l] == s[r]) {
+                    l++;
+                    r++;
+                }
+                if (l == n || r == n || s[l] != s[r]) iguales = false;
+            }
+            if (!iguales) nombre++;
+            reducida[indiceLMS[lmsOrdenadas[i]]] = nombre;
+        }
+
+        vector<int> saReducido = construirSAIS(reducida, nombre + 1);
+        for (int i = 0; i < m; i++) {
+            lmsOrdenadas[i] = lms[saReducido[i]];
+        }
+        inducir(lmsOrdenadas);
+    }
+    return sa;
+}
+
+// Indice de sufijos persistente sobre un archivo, para responder muchas busquedas sin releerlo.
+// El texto se divide en segmentos (el original y cada agregado posterior); cada segmento tiene su
+// propio arreglo de sufijos, asi al agregar datos al final solo se ordenan los sufijos nuevos.
+// Las posiciones se guardan en 4 bytes y SA-IS trabaja con int: sirve para archivos de hasta 2 GB.
+//
+// Formato del archivo de indice (todos los enteros en little endian, pensado para poder mapearse):
+//   "SAIX" | tamaño del texto (8 bytes) | fecha de modificacion del archivo indexado (8 bytes)
+//   | cantidad de segmentos (4 bytes)
+//   | fin de cada segmento (8 bytes c/u) | texto | relleno hasta multiplo de 4 | sufijos (4 bytes c/u)
+class IndiceSufijos {
+private:
+    string texto;               // Copia del texto indexado
+    vector<uint64_t> finSegmento; // Fin (exclusivo) de cada segmento; empiezan donde termina el anterior
+    vector<uint32_t> sufijos;   // Arreglos de sufijos de cada segmento, uno detras del otro
+    uint64_t fechaArchivo = 0;  // Fecha de modificacion del archivo cuando se indexo
+
+    static const size_t MAX_SEGMENTOS = 16; // Pasado este numero se reconstruye todo de cero
+
+    // Ordena los sufijos de texto[inicio, fin) y los agrega al final de sufijos
+    void indexarSegmento(size_t inicio, size_t fin) {
+        vector<int> s(texto.begin() + inicio, texto.begin() + fin);
+        for (int& c : s) c = (unsigned char)c;
+        for (int p : construirSAIS(s, 256)) {
+            sufijos.push_back((uint32_t)(inicio + p));
+        }
+        finSegmento.push_back(fin);
+    }
+
+    // Compara el sufijo que empieza en pos (cortado en fin) contra el patron, mirando a lo sumo m bytes
+    int compararSufijo(size_t pos, size_t fin, const string& patron) const {
+        size_t largo = min(fin - pos, patron.size());
+        int r = texto.compare(pos, largo, patron, 0, largo);
+        if (r != 0) return r;
+        return largo < patron.size() ? -1 : 0;
+    }
+
+    static void escribirEntero(ostream& out, uint64_t v, int bytes) {
+        for (int i = 0; i < bytes; i++) out.put((v >> (8 * i)) & 0xFF);
+    }
+
+    static bool leerEntero(istream& in, uint64_t& v, int bytes) {
+        unsigned char b[8];
+        if (!in.read(reinterpret_cast<char*>(b), bytes)) return false;
+        v = 0;
+        for (int i = bytes - 1; i >= 0; i--) v = (v << 8) | b[i];
+        return true;
+    }
+
+public:
+    // Tamaño maximo del texto: SA-IS usa int y las posiciones se guardan en 4 bytes
+    static const size_t MAX_TEXTO = 0x7FFFFFFF;
+
+    size_t tamTexto() const { return texto.size(); }
+    size_t cantidadSegmentos() const { return finSegmento.size(); }
+    uint64_t fecha() const { return fechaArchivo; }
+    void fecha(uint64_t f) { fechaArchivo = f; }
+
+    // true si contenido empieza con el texto indexado (es decir, solo se le agregaron datos al final)
+    bool esPrefijoDe(const string& contenido) const {
+        return contenido.size() >= texto.size() && contenido.compare(0, texto.size(), texto) == 0;
+    }
+
+    // Indexa un texto completo desde cero
+    void construir(const string& contenido) {
+        texto = contenido;
+        finSegmento.clear();
+        sufijos.clear();
+        sufijos.reserve(texto.size());
+        if (!texto.empty()) indexarSegmento(0, texto.size());
+    }
+
+    // Agrega datos al final del texto indexado; solo se ordenan los sufijos nuevos
+    void agregar(const string& agregado) {
+        if (agregado.empty()) return;
+        if (finSegmento.size() >= MAX_SEGMENTOS) {
+            construir(texto + agregado);
+            return;
+        }
+        size_t inicio = texto.size();
+        texto += agregado;
+        indexarSegmento(inicio, texto.size());
+    }
+
+    // Devuelve las posiciones (ordenadas) donde aparece el patron. O(segmentos * m log n)
+    vector<size_t> buscar(const string& patron) const {
+        vector<size_t> posiciones;
+        size_t m = patron.size();
+        if (m == 0) return posiciones;
+
+        size_t inicio = 0;
+        for (size_t seg = 0; seg < finSegmento.size(); seg++) {
+            size_t fin = finSegmento[seg];
+            auto primero = sufijos.begin() + inicio;
+            auto ultimo = sufijos.begin() + fin;
+
+            // Rango de sufijos del segmento que empiezan con el patron
+            auto desde = lower_bound(primero, ultimo, patron, [&](uint32_t pos, const string& p) {
+                return compararSufijo(pos, fin, p) < 0;
+            });
+            auto hasta = upper_bound(desde, ultimo, patron, [&](const string& p, uint32_t pos) {
+                return compararSufijo(pos, fin, p) > 0;
+            });
+            posiciones.insert(posiciones.end(), desde, hasta);
+
+            // Los ultimos m-1 sufijos del segmento quedaron cortados: un match ahi cruza al segmento siguiente
+            for (size_t pos = (fin - inicio >= m) ? fin - m + 1 : inicio; pos < fin; pos++) {
+                if (pos + m <= texto.size() && texto.compare(pos, m, patron) == 0) {
+                    posiciones.push_back(pos);
+                }
+            }
+            inicio = fin;
+        }
+
+        sort(posiciones.begin(), posiciones.end());
+        return posiciones;
+    }
+
+    // Guarda el indice en disco
+    bool guardar(const string& ruta) const {
+        ofstream out(ruta, ios::binary);
+        if (!out) return false;
+        out.write("SAIX", 4);
+        escribirEntero(out, texto.size(), 8);
+        escribirEntero(out, fechaArchivo, 8);
+        escribirEntero(out, finSegmento.size(), 4);
+        for (uint64_t fin : finSegmento) escribirEntero(out, fin, 8);
+        out.write(texto.data(), texto.size());
+        for (size_t i = texto.size(); i % 4 != 0; i++) out.put(0);
+        for (uint32_t pos : sufijos) escribirEntero(out, pos, 4);
+        return (bool)out;
+    }
+
+    // Carga un indice guardado. Devuelve false si no existe o esta dañado
+    bool cargar(const string& ruta) {
+        error_code ec;
+        uint64_t tamIndice = fs::file_size(ruta, ec);
+        if (ec) return false;
+
+        ifstream in(ruta, ios::binary);
+        char magia[4];
+        uint64_t n, segmentos;
+        if (!in.read(magia, 4) || string(magia, 4) != "SAIX") return false;
+        if (!leerEntero(in, n, 8) || !leerEntero(in, fechaArchivo, 8) || !leerEntero(in, segmentos, 4)) return false;
+        if (segmentos > MAX_SEGMENTOS || n > MAX_TEXTO) return false;
+
+        // El tamaño del archivo tiene que coincidir con lo que dice el encabezado antes de reservar memoria
+        uint64_t esperado = 4 + 8 + 8 + 4 + 8 * segmentos + n + (4 - n % 4) % 4 + 4 * n;
+        if (esperado != tamIndice) return false;
+
+        finSegmento.assign(segmentos, 0);
+        uint64_t anterior = 0;
+        for (uint64_t& fin : finSegmento) {
+            if (!leerEntero(in, fin, 8) || fin <= anterior || fin > n) return false;
+            anterior = fin;
+        }
+        if (anterior != n) return false;
+        texto.assign(n, '\0');
+        if (!in.read(&texto[0], n)) return false;
+        in.seekg((4 - n % 4) % 4, ios::cur);
+
+        sufijos.assign(n, 0);
+        if (!in.read(reinterpret_cast<char*>(sufijos.data()), n * 4)) return false;
+        for (uint32_t& pos : sufijos) {
+            unsigned char* b = reinterpret_cast<unsigned char*>(&pos);
+            pos = b[0] | (b[1] << 8) | (b[2] << 16) | ((uint32_t)b[3] << 24);
+            if (pos >= n) return false;
+        }
+        return true;
+    }
+};
+
+// Crea o actualiza el indice de rutaArchivo y lo guarda en rutaIndice.
+// Si el tamaño y la fecha de modificacion coinciden con los del indice no se lee el archivo.
+// Si no, se compara el archivo con el texto indexado: si solo se agregaron datos al final se indexan
+// unicamente esos bytes; cualquier otro cambio reconstruye el indice completo
+bool actualizarIndice(const string& rutaArchivo, const string& rutaIndice, IndiceSufijos& indice) {
+    if (!fs::exists(rutaArchivo)) {
+        cout << "No se encontro el archivo para indexar: " << rutaArchivo << endl;
+        return false;
+    }
+    size_t tamArchivo = fs::file_size(rutaArchivo);
+    if (tamArchivo > IndiceSufijos::MAX_TEXTO) {
+        cout << "Archivo demasiado grande para indexar (" << tamArchivo << " bytes, maximo "
+             << IndiceSufijos::MAX_TEXTO << ")." << endl;
+        return false;
+    }
+    uint64_t fecha = fs::last_write_time(rutaArchivo).time_since_epoch().count();
+    bool cargado = indice.cargar(rutaIndice);
+    if (cargado && tamArchivo == indice.tamTexto() && fecha == indice.fecha()) {
+        cout << "Indice al dia (" << indice.cantidadSegmentos() << " segmentos)." << endl;
+        return true;
+    }
+
+    ifstream archivo(rutaArchivo, ios::binary);
+    if (!archivo) {
+        cout << "No se pudo abrir el archivo: " << rutaArchivo << endl;
+        return false;
+    }
+    string contenido((istreambuf_iterator<char>(archivo)), istreambuf_iterator<char>());
+    if (cargado && indice.esPrefijoDe(contenido)) {
+        size_t agregados = contenido.size() - indice.tamTexto();
+        indice.agregar(contenido.substr(indice.tamTexto()));
+        if (agregados > 0) cout << "Indice actualizado con " << agregados << " bytes nuevos." << endl;
+        else cout << "Indice al dia (" << indice.cantidadSegmentos() << " segmentos)." << endl;
     } else {
-        cout << "Cadena encontrada " << posiciones.size() << " veces en " << rutaArchivo << "." << endl;
-        cout << "Posiciones (offset desde inicio del archivo, base 0): ";
-        for (size_t p : posiciones) cout << p << " ";
-        cout << endl;
+        indice.construir(contenido);
+        cout << "Indice construido (" << contenido.size() << " bytes)." << endl;
+    }
+
+    indice.fecha(fecha);
+    if (!indice.guardar(rutaIndice)) {
+        cout << "No se pudo guardar el indice en: " << rutaIndice << endl;
+        return false;
     }
+    return true;
 }
 
 // Flujo principal del programa
@@ -160,6 +484,25 @@ int main() {
         }
     }
 
+    // Modo 1: recorre el archivo en cada busqueda. Modo 2: solo crea/actualiza el indice.
+    // Modo 3: responde varias busquedas con el indice sin volver a leer el archivo
+    cout << "Modo de busqueda (1 = recorrer archivo, 2 = construir indice, 3 = buscar con indice): ";
+    string modo;
+    getline(cin, modo);
+    if (modo == "2" || modo == "3") {
+        IndiceSufijos indice;
+        if (!actualizarIndice(ASSETS_PATH, INDICE_PATH, indice)) return 1;
+        if (modo == "2") return 0;
+
+        string consulta;
+        while (true) {
+            cout << "Ingrese la cadena a buscar en " << ASSETS_PATH << " (vacia para terminar): ";
+            if (!getline(cin, consulta) || consulta.empty()) break;
+            mostrarPosiciones(ASSETS_PATH, indice.buscar(consulta));
+        }
+        return 0;
+    }
+
     cout << "Ingrese la cadena a buscar en " << ASSETS_PATH << ": ";
     string cadena;
     getline(cin, cadena); // Lee entrada completa
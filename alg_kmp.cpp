@@ -4,6 +4,9 @@
 #include <string>       
 #include <filesystem>  
 #include <chrono>     
+#include <cstdint>
+#include <iterator>
+#include <algorithm>
 
 using namespace std;
 namespace fs = std::filesystem; 
@@ -13,6 +16,28 @@ private:
     string patron;      // Patron a buscar
     vector<int> lps;    // Arreglo LPS
 
+    // Tablas de la busqueda sobre LZW (se construyen recien en la primera busqueda comprimida)
+    vector<vector<int>> automata;      // Automata KMP: automata[estado][byte] -> siguiente estado
+    vector<vector<int>> subcadenas;    // Automata de sufijos del patron: reconoce sus subcadenas
+    vector<bool> esSufijo;             // Estados del automata de sufijos que son sufijos del patron
+    vector<vector<int>> cruce;         // cruce[k][q]: mayor borde k' <= k (en la cadena de LPS) que completa el
+                                       // patron con un prefijo de frase de q bytes que es sufijo del patron
+
+    // Resumen de una entrada del diccionario LZW respecto del patron.
+    // Permite avanzar sobre la frase completa en O(1) sin expandirla
+    struct EntradaLZW {
+        size_t longitud = 0;            // Longitud de la frase
+        unsigned char primero = 0;      // Primer byte de la frase
+        int prefijoSufijo = 0;          // Prefijo mas largo de la frase que es sufijo del patron
+        int estadoFinal = 0;            // Estado del automata al terminar la frase empezando desde 0
+        int estadoSubcadena = 0;        // Estado en el automata de sufijos (-1 si la frase no esta dentro del patron)
+        vector<int> transicion;         // Solo si la frase es subcadena del patron y mide menos de m-1:
+                                        // estado al terminarla empezando desde cada estado posible
+        size_t coincidencias = 0;       // Matches que empiezan y terminan dentro de la frase
+        int ultimaCoincidencia = -1;    // Prefijo mas largo de la frase (ella misma incluida) que termina en un match
+        int anteriorCoincidencia = -1;  // Si esta entrada termina en match, el siguiente prefijo que tambien lo hace
+    };
+
     // Construye el arreglo LPS para el patron 
     void construirLPS() {
         int m = patron.size();
@@ -41,7 +66,117 @@ private:
         }
     }
 
+    // Construye las tablas que usa buscarEnLZWConContador
+    void construirTablasLZW() {
+        int m = patron.size();
+
+        // Automata KMP a partir de LPS (estados 0..m-1; tras un match se vuelve a lps[m-1])
+        automata.assign(m, vector<int>(256, 0));
+        for (int j = 0; j < m; j++) {
+            for (int c = 0; c < 256; c++) {
+                if ((unsigned char)patron[j] == c) automata[j][c] = j + 1;
+                else automata[j][c] = (j == 0) ? 0 : automata[lps[j - 1]][c];
+            }
+        }
+
+        // Automata de sufijos del patron (construccion incremental clasica)
+        vector<int> largo(1, 0), enlace(1, -1);
+        subcadenas.assign(1, vector<int>(256, -1));
+        int ultimo = 0;
+        for (char ch : patron) {
+            unsigned char c = ch;
+            int actual = subcadenas.size();
+            subcadenas.push_back(vector<int>(256, -1));
+            largo.push_back(largo[ultimo] + 1);
+            enlace.push_back(0);
+            int p = ultimo;
+            while (p != -1 && subcadenas[p][c] == -1) {
+                subcadenas[p][c] = actual;
+                p = enlace[p];
+            }
+            if (p != -1) {
+                int q = subcadenas[p][c];
+                if (largo[p] + 1 == largo[q]) {
+                    enlace[actual] = q;
+                } else {
+                    int copia = subcadenas.size();
+                    subcadenas.push_back(subcadenas[q]);
+                    largo.push_back(largo[p] + 1);
+                    enlace.push_back(enlace[q]);
+                    while (p != -1 && subcadenas[p][c] == q) {
+                        subcadenas[p][c] = copia;
+                        p = enlace[p];
+                    }
+                    enlace[q] = copia;
+                    enlace[actual] = copia;
+                }
+            }
+            ultimo = actual;
+        }
+        esSufijo.assign(subcadenas.size(), false);
+        for (int p = ultimo; p != -1; p = enlace[p]) esSufijo[p] = true;
+
+        // Un borde k del texto y una frase cuyos primeros q bytes son patron[m-q..m) forman un match
+        // que cruza el limite si patron[k..m) es prefijo de esos q bytes.
+        // La columna q usa la fila a = m-q de lce (prefijo comun entre patron[a..] y patron[b..]);
+        // las filas se calculan de abajo hacia arriba guardando solo la anterior
+        cruce.assign(m, vector<int>(m + 1, 0));
+        vector<int> fila(m + 1, 0), siguiente(m + 1, 0);
+        for (int a = m - 1; a >= 0; a--) {
+            for (int b = 0; b < m; b++) {
+                fila[b] = (patron[a] == patron[b]) ? siguiente[b + 1] + 1 : 0;
+            }
+            int q = m - a;
+            for (int k = 1; k < m; k++) {
+                bool completa = (m - k <= q) && fila[k] >= m - k;
+                cruce[k][q] = completa ? k : cruce[lps[k - 1]][q];
+            }
+            swap(fila, siguiente);
+        }
+    }
+
+    // Avanza el automata con un byte. Devuelve true si se completo el patron
+    bool avanzar(int &estado, unsigned char c) const {
+        estado = automata[estado][c];
+        if (estado == (int)patron.size()) {
+            estado = lps[estado - 1];
+            return true;
+        }
+        return false;
+    }
+
+    // Crea la entrada p + c (que tendra el codigo indice) a partir del resumen de p.
+    // Suma a pasos el trabajo hecho (m si hubo que armar la tabla de transicion)
+    EntradaLZW extender(const EntradaLZW &p, unsigned char c, int indice, long long &pasos) const {
+        int m = patron.size();
+        EntradaLZW e;
+        e.longitud = p.longitud + 1;
+        e.primero = (p.longitud == 0) ? c : p.primero;
+        e.estadoFinal = p.estadoFinal;
+        bool termina = avanzar(e.estadoFinal, c);
+        e.coincidencias = p.coincidencias + (termina ? 1 : 0);
+        e.ultimaCoincidencia = termina ? indice : p.ultimaCoincidencia;
+        e.anteriorCoincidencia = termina ? p.ultimaCoincidencia : -1;
+
+        // Si la frase sigue dentro del patron, puede ser un prefijo mas largo que sea sufijo del patron
+        e.estadoSubcadena = (p.estadoSubcadena == -1) ? -1 : subcadenas[p.estadoSubcadena][c];
+        bool esSufijoDelPatron = e.estadoSubcadena != -1 && esSufijo[e.estadoSubcadena];
+        e.prefijoSufijo = esSufijoDelPatron ? (int)e.longitud : p.prefijoSufijo;
+
+        // Solo una frase corta contenida en el patron puede extender un borde previo sin pasar por
+        // estadoFinal; para esas se guarda la transicion completa (a lo sumo una vez por entrada)
+        if (e.estadoSubcadena != -1 && e.longitud + 1 < (size_t)m) {
+            e.transicion = p.transicion;
+            for (int &t : e.transicion) avanzar(t, c);
+            pasos += m;
+        }
+        return e;
+    }
+
 public:   
+    // Largo maximo del patron en la busqueda comprimida: sus tablas ocupan O(m^2)
+    static const int MAX_PATRON_LZW = 1024;
+
     // Constructor recibe el patron y construye LPS automaticamente
     KMPCounter(const string& p) : patron(p) {
         construirLPS();
@@ -91,8 +226,148 @@ public:
 
         return resultados;
     }
+
+    // Busca el patron directamente sobre los codigos LZW de un archivo comprimido, sin descomprimirlo
+    // (Amir-Benson-Farach). Cada entrada del diccionario se resume con su longitud, el estado del automata
+    // al terminarla y el prefijo mas largo que es sufijo del patron; con la tabla cruce cada codigo cuesta
+    // O(1) mas O(1) por match, en vez de recorrer los bytes de la frase.
+    // Devuelve pares (posicion_inicio_de_ocurrencia, pasos_acumulados_al_encontrar).
+    // Ademas modifica pasos por referencia con el total: uno por codigo, uno por match y m por cada
+    // tabla de transicion armada al crear entradas.
+    vector<pair<size_t, long long>> buscarEnLZWConContador(const vector<uint16_t>& codigos, int maxBits,
+                                                          long long &pasos) {
+        vector<pair<size_t, long long>> resultados;
+        pasos = 0;
+        int m = (int)patron.size();
+        if (m == 0 || codigos.empty()) return resultados;
+        if (m > MAX_PATRON_LZW) {
+            cerr << "Patron demasiado largo para la busqueda comprimida (maximo " << MAX_PATRON_LZW << " bytes)" << endl;
+            return resultados;
+        }
+        if (automata.empty()) construirTablasLZW();
+
+        // Frase vacia: a partir de ella se arman los 256 bytes sueltos del diccionario inicial
+        EntradaLZW vacia;
+        if (m > 1) {
+            vacia.transicion.resize(m);
+            for (int k = 0; k < m; k++) vacia.transicion[k] = k;
+        }
+        vector<EntradaLZW> dic;
+        dic.reserve((size_t)1 << maxBits);
+        for (int c = 0; c < 256; c++) {
+            dic.push_back(extender(vacia, (unsigned char)c, c, pasos));
+        }
+
+        size_t posicion = 0; // Offset (en el archivo original) donde empieza la frase actual
+        int estado = 0;      // Estado del automata antes de la frase actual
+        int anterior = -1;   // Codigo anterior (para agregar entradas igual que el descompresor)
+
+        for (uint16_t codigo : codigos) {
+            if (anterior != -1 && dic.size() < ((size_t)1 << maxBits)) {
+                // La nueva entrada es anterior + primer byte de la frase actual
+                // (si el codigo es justo el siguiente, ese byte es el primero de la anterior)
+                if (codigo > dic.size()) {
+                    cerr << "Error en busqueda: codigo invalido" << endl;
+                    return {};
+                }
+                unsigned char primero = (codigo == dic.size()) ? dic[anterior].primero : dic[codigo].primero;
+                EntradaLZW nueva = extender(dic[anterior], primero, dic.size(), pasos);
+                dic.push_back(move(nueva));
+            } else if (codigo >= dic.size()) {
+                cerr << "Error en busqueda: codigo invalido" << endl;
+                return {};
+            }
+            const EntradaLZW &e = dic[codigo];
+            pasos++;
+
+            // Matches que empezaron antes de la frase: bordes del estado actual que el prefijo de la frase completa
+            for (int k = cruce[estado][e.prefijoSufijo]; k > 0; k = cruce[lps[k - 1]][e.prefijoSufijo]) {
+                pasos++;
+                resultados.emplace_back(posicion - k, pasos);
+            }
+
+            // Matches internos: se recorren en orden desde el prefijo mas corto
+            if (e.coincidencias > 0) {
+                size_t desde = resultados.size();
+                for (int i = e.ultimaCoincidencia; i != -1; i = dic[i].anteriorCoincidencia) {
+                    pasos++;
+                    resultados.emplace_back(posicion + dic[i].longitud - m, pasos);
+                }
+                reverse(resultados.begin() + desde, resultados.end());
+            }
+
+            // Sin tabla de transicion el estado final no depende del estado previo
+            estado = e.transicion.empty() ? e.estadoFinal : e.transicion[estado];
+
+            posicion += e.longitud;
+            anterior = codigo;
+        }
+
+        return resultados;
+    }
 };
 
+// CRC32C (polinomio Castagnoli reflejado) por tabla, el mismo que usa alg_LZiv en sus trailers
+uint32_t crc32c(const vector<unsigned char>& datos) {
+    static uint32_t tabla[256];
+    static bool lista = false;
+    if (!lista) {
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t c = i;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? (c >> 1) ^ 0x82F63B78u : c >> 1;
+            tabla[i] = c;
+        }
+        lista = true;
+    }
+    uint32_t crc = 0xFFFFFFFFu;
+    for (unsigned char byte : datos) crc = tabla[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+// Carga los codigos LZW de un archivo .rar (codigos de maxBits bits empaquetados, como en alg_LZiv).
+// El archivo termina con un trailer de 8 bytes: cantidad de codigos y CRC32C de los bytes empaquetados.
+// Si el CRC no coincide no se busca sobre datos corruptos
+vector<uint16_t> cargarCodigosLZW(const string& ruta, int maxBits) {
+    const size_t TAM_TRAILER = 8;
+    ifstream in(ruta, ios::binary);
+    if (!in) {
+        cerr << "No se pudo abrir: " << ruta << ' ';
+        return {};
+    }
+    vector<unsigned char> bytes((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    if (bytes.size() < TAM_TRAILER) {
+        cerr << "Archivo .rar sin trailer: " << ruta << ' ';
+        return {};
+    }
+    const unsigned char* trailer = bytes.data() + bytes.size() - TAM_TRAILER;
+    uint32_t cantidad = trailer[0] | (trailer[1] << 8) | (trailer[2] << 16) | ((uint32_t)trailer[3] << 24);
+    uint32_t crc = trailer[4] | (trailer[5] << 8) | (trailer[6] << 16) | ((uint32_t)trailer[7] << 24);
+    bytes.resize(bytes.size() - TAM_TRAILER);
+    if (crc32c(bytes) != crc) {
+        cerr << "CRC invalido en: " << ruta << ' ';
+        return {};
+    }
+
+    vector<uint16_t> codigos;
+    uint32_t buffer = 0;
+    int bitsEnBuffer = 0;
+    for (unsigned char byte : bytes) {
+        buffer |= ((uint32_t)byte << bitsEnBuffer);
+        bitsEnBuffer += 8;
+        while (bitsEnBuffer >= maxBits) {
+            codigos.push_back(buffer & ((1u << maxBits) - 1));
+            buffer >>= maxBits;
+            bitsEnBuffer -= maxBits;
+        }
+    }
+    if (codigos.size() < cantidad) {
+        cerr << "Archivo .rar incompleto: " << ruta << ' ';
+        return {};
+    }
+    codigos.resize(cantidad);
+    return codigos;
+}
+
 // Lee el archivo completo y devuelve su contenido.
 // Si falla, devuelve una cadena vacia
 string leerArchivo(const string& ruta) {
@@ -114,14 +389,34 @@ string leerArchivo(const string& ruta) {
 
 // Flujo principal del programa
 int main() {
-    const string rutaArchivo = "assets/kmp.txt"; // Ruta del archivo a analizar
+    string rutaArchivo = "assets/kmp.txt"; // Ruta del archivo a analizar
+    const int LZW_BITS = 12;               // Ancho de codigo de los .rar que genera alg_LZiv
 
-    // Lee el archivo completo
-    string texto = leerArchivo(rutaArchivo);
-    if (texto.empty()) {
-        // Si el archivo no existe o esta vacio, informamos
-        cerr << "El archivo esta vacio o no se pudo leer. Asegurate de que " << rutaArchivo << " exista." << endl;
-        return 1;
+    // Modo 1: texto plano. Modo 2: busqueda directa sobre un archivo comprimido con LZW (.rar)
+    cout << "Buscar en (1 = " << rutaArchivo << ", 2 = archivo comprimido LZW .rar): ";
+    string modo;
+    getline(cin, modo);
+    bool comprimido = (modo == "2");
+
+    string texto;
+    vector<uint16_t> codigos;
+    if (comprimido) {
+        cout << "Ingrese la ruta del archivo .rar (ej: compressed/lz.txt.rar): ";
+        getline(cin, rutaArchivo);
+        // Solo se cargan los codigos, el archivo original nunca se reconstruye
+        codigos = cargarCodigosLZW(rutaArchivo, LZW_BITS);
+        if (codigos.empty()) {
+            cerr << "El archivo comprimido esta vacio o no se pudo leer: " << rutaArchivo << endl;
+            return 1;
+        }
+    } else {
+        // Lee el archivo completo
+        texto = leerArchivo(rutaArchivo);
+        if (texto.empty()) {
+            // Si el archivo no existe o esta vacio, informamos
+            cerr << "El archivo esta vacio o no se pudo leer. Asegurate de que " << rutaArchivo << " exista." << endl;
+            return 1;
+        }
     }
 
     cout << "Ingrese la cadena a buscar: ";
@@ -132,6 +427,12 @@ int main() {
         cout << "Cadena vacia. Saliendo." << endl;
         return 0;
     }
+    if (comprimido && patron.size() > (size_t)KMPCounter::MAX_PATRON_LZW) {
+        // Las tablas de la busqueda comprimida crecen con m^2; para patrones largos conviene descomprimir
+        cout << "Patron demasiado largo para buscar en el archivo comprimido (maximo "
+             << KMPCounter::MAX_PATRON_LZW << " bytes). Descomprima el archivo con alg_LZiv y busque en modo 1." << endl;
+        return 1;
+    }
 
     // Ejecutamos KMP con contador de comparaciones y medimos el tiempo de ejecucion
     KMPCounter buscador(patron);     // Construimos LPS dentro del constructor
@@ -141,29 +442,37 @@ int main() {
     auto t0 = chrono::steady_clock::now();
 
     // Llama al metodo que realiza la busqueda y devuelve las ocurrencias
-    vector<pair<size_t, long long>> ocurrencias = buscador.buscarEnTextoConContador(texto, comparacionesTotales);
+    // (en modo comprimido el contador son pasos sobre los codigos en vez de comparaciones)
+    vector<pair<size_t, long long>> ocurrencias = comprimido
+        ? buscador.buscarEnLZWConContador(codigos, LZW_BITS, comparacionesTotales)
+        : buscador.buscarEnTextoConContador(texto, comparacionesTotales);
 
     // Toma de tiempo (fin)
     auto t1 = chrono::steady_clock::now();
     // Convierte la duracion a milisegundos en formato double
     double ms = chrono::duration_cast<chrono::duration<double, milli>>(t1 - t0).count();
 
+    // Nombre del contador segun el modo
+    string contador = comprimido ? "Pasos" : "Comparaciones";
+    string realizados = comprimido ? "realizados" : "realizadas";
+
     // Mostramos el resultado
     if (ocurrencias.empty()) {
         // Si no se encontraron ocurrencias, mostramos comparaciones totales y tiempo
         cout << "La cadena \"" << patron << "\" NO se encontro en el archivo." << endl;
-        cout << "Comparaciones realizadas: " << comparacionesTotales << endl;
+        cout << contador << " " << realizados << ": " << comparacionesTotales << endl;
         cout << "Tiempo de busqueda: " << ms << " ms" << endl;
     } else {
         // Mostramos cuantas veces se encontro y los detalles de cada ocurrencia
         cout << "La cadena \"" << patron << "\" se encontro " << ocurrencias.size() << " veces." << endl;
-        cout << "Resultados (posicion_inicio, comparaciones_acumuladas_al_encontrar):" << endl;
+        cout << "Resultados (posicion_inicio, " << (comprimido ? "pasos_acumulados" : "comparaciones_acumuladas")
+            << "_al_encontrar):" << endl;
         for (size_t k = 0; k < ocurrencias.size(); ++k) {
             cout << "  #" << (k + 1) << ": pos = " << ocurrencias[k].first
-                << ", comparaciones = " << ocurrencias[k].second << ' ';
+                << ", " << (comprimido ? "pasos" : "comparaciones") << " = " << ocurrencias[k].second << ' ';
         }
         // Mostramos los totales acumulados y el tiempo tomado
-        cout << "Comparaciones totales realizadas durante toda la busqueda: " << comparacionesTotales << endl;
+        cout << contador << " totales " << realizados << " durante toda la busqueda: " << comparacionesTotales << endl;
         cout << "Tiempo de busqueda: " << ms << " ms" << endl;
     }
 